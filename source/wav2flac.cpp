@@ -12,6 +12,20 @@
 #include <map>
 #include <locale>
 #include <codecvt>
+#include <cerrno>
+#include <cstring>
+#include <cmath>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__linux__)
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
 
 namespace fs = std::filesystem;
 
@@ -20,9 +34,37 @@ struct ConversionState {
     std::atomic<int> total_files{0};
     std::atomic<int> processed{0};
     std::atomic<int> errors{0};
+    std::atomic<int> handled{0}; // Converted, moved, deleted or failed: drives the progress bar
+    std::atomic<size_t> next_file{0};
     std::vector<std::string> error_messages;
     std::mutex log_mutex;
-    bool stop_requested{false};
+    std::atomic<bool> stop_requested{false};
+};
+
+// Structure to hold resource governor settings and the live worker limit
+struct GovernorSettings {
+    bool enabled{false};
+    unsigned int max_workers{1};
+    double max_cpu_load{85.0};              // Busy CPU time (%) above which the pool shrinks
+    double max_iowait{20.0};                // CPU time waiting on I/O (%) above which the pool shrinks
+    double max_memory_pressure{10.0};       // Memory stall time (%) above which the pool is halved
+    int priority{0};                        // 0 = normal, 1 = low, 2 = idle
+    std::vector<unsigned int> cpu_affinity; // Empty means all cores
+    std::atomic<unsigned int> active_workers{1};
+};
+
+// Structure to hold the previous cumulative memory stall sample
+struct MemoryStall {
+    unsigned long long stall_us{0};
+    std::chrono::steady_clock::time_point time;
+    bool valid{false};
+};
+
+// Structure to hold a snapshot of the cumulative CPU counters
+struct CpuTimes {
+    unsigned long long total{0};
+    unsigned long long idle{0};
+    unsigned long long iowait{0};
 };
 
 // Structure to track filename conversions
@@ -58,6 +100,17 @@ const std::vector<std::string> unrecognized_extensions = {".dat", ""};
 const std::vector<std::string> documentation_extensions = {".html", ".docx", ".doc", ".pdf", ".jpg", ".jpeg", ".png", ".txt", ".rtf", ".xml", ".asc", ".msg", ".wpd", ".wps", ".url"};
 const std::vector<std::string> archive_extensions = {".zip", ".rar", ".7z", ".tar", ".gz", ".bz2", ".xz"};
 
+// File categories, in the order they are checked
+enum class FileCategory {
+    hidden, analysis, unrecognized, documentation, archive, lossless,
+    midi, arturia, serum, vital, ableton, natinst, other
+};
+
+// Resource governor tuning
+const int governor_interval_ms = 500;
+const double governor_headroom = 10.0; // CPU load (%) below the cap required before adding a worker
+const unsigned int max_worker_threads = 1024;
+
 // Character mapping for non-ASCII to ASCII conversion
 const std::map<char32_t, std::string> ascii_conversion_map = {
     // Latin characters with diacritics
@@ -92,6 +145,52 @@ bool has_extension(const std::string& extension, const std::vector<std::string>&
     return std::find(extensions.begin(), extensions.end(), extension) != extensions.end();
 }
 
+// Function to classify a file by name and extension
+FileCategory classify_file(const fs::path& file) {
+    std::string filename = file.filename().string();
+    if (filename.rfind("._", 0) == 0 || filename == ".DS_Store") return FileCategory::hidden;
+
+    std::string extension = file.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    if (has_extension(extension, analysis_extensions)) return FileCategory::analysis;
+    if (has_extension(extension, unrecognized_extensions)) return FileCategory::unrecognized;
+    if (has_extension(extension, documentation_extensions)) return FileCategory::documentation;
+    if (has_extension(extension, archive_extensions)) return FileCategory::archive;
+    if (has_extension(extension, lossless_extensions)) return FileCategory::lossless;
+    if (has_extension(extension, midi_extensions)) return FileCategory::midi;
+    if (has_extension(extension, arturia_extensions)) return FileCategory::arturia;
+    if (has_extension(extension, serum_extensions)) return FileCategory::serum;
+    if (has_extension(extension, vital_extensions)) return FileCategory::vital;
+    if (has_extension(extension, ableton_extensions)) return FileCategory::ableton;
+    if (has_extension(extension, natinst_extensions)) return FileCategory::natinst;
+    return FileCategory::other;
+}
+
+// Function to get the display name of a file category
+std::string category_name(FileCategory category) {
+    switch (category) {
+        case FileCategory::hidden:        return "hidden";
+        case FileCategory::analysis:      return "analysis";
+        case FileCategory::unrecognized:  return "unrecognized";
+        case FileCategory::documentation: return "documentation";
+        case FileCategory::archive:       return "archive";
+        case FileCategory::lossless:      return "lossless";
+        case FileCategory::midi:          return "midi";
+        case FileCategory::arturia:       return "arturia";
+        case FileCategory::serum:         return "serum";
+        case FileCategory::vital:         return "vital";
+        case FileCategory::ableton:       return "ableton";
+        case FileCategory::natinst:       return "natinst";
+        default:                          return "other";
+    }
+}
+
+// Helper function to check if a core belongs to a CPU list
+bool has_cpu(const std::vector<unsigned int>& cpus, unsigned int cpu) {
+    return std::find(cpus.begin(), cpus.end(), cpu) != cpus.end();
+}
+
 // Function to check if a string contains non-ASCII characters
 bool contains_non_ascii(const std::string& str) {
     for (unsigned char c : str) {
@@ -292,8 +391,9 @@ bool convert_file(const fs::path& input_path, const fs::path& output_path, Conve
         std::string quoted_input = "\"" + input_path.string() + "\"";
         std::string quoted_output = "\"" + output_path.string() + "\"";
         
-        std::string cmd = "ffmpeg -v error -y -i " + quoted_input + 
-                         " -c:a flac -compression_level 12 " + quoted_output;
+        // Single-threaded filters (global option) and encoder (output option): about one core per worker
+        std::string cmd = "ffmpeg -v error -y -filter_threads 1 -i " + quoted_input +
+                         " -threads 1 -c:a flac -compression_level 12 " + quoted_output;
 
         if (!execute_command(cmd)) {
             std::lock_guard<std::mutex> lock(state.log_mutex);
@@ -321,9 +421,217 @@ void move_file_with_relative_structure(const fs::path& file, const fs::path& bas
     }
 }
 
-// Updated worker thread function
-void process_batch(const std::vector<fs::path>& batch, 
-                  ConversionState& state, 
+// Function to read cumulative CPU counters, summed over the given cores (all cores if empty)
+bool read_cpu_times(CpuTimes& times, const std::vector<unsigned int>& cpus) {
+#if defined(_WIN32)
+    // Per-core times are not in the Win32 API: pinned runs are measured machine-wide
+    (void)cpus;
+    FILETIME idle_time, kernel_time, user_time;
+    if (!GetSystemTimes(&idle_time, &kernel_time, &user_time)) return false;
+    auto to_ticks = [](const FILETIME& ft) {
+        return (static_cast<unsigned long long>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+    };
+    times.idle = to_ticks(idle_time);
+    times.total = to_ticks(kernel_time) + to_ticks(user_time); // Kernel time already includes idle time
+    times.iowait = 0; // Not exposed by Windows
+    return true;
+#elif defined(__linux__)
+    std::ifstream stat_file("/proc/stat");
+    std::string line;
+    bool found = false;
+    times = CpuTimes();
+    while (std::getline(stat_file, line) && line.rfind("cpu", 0) == 0) {
+        std::istringstream fields(line);
+        std::string label;
+        unsigned long long user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+        if (!(fields >> label >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal)) continue;
+
+        // "cpu" is the machine-wide line, "cpuN" the per-core ones
+        if (cpus.empty() != (label == "cpu")) continue;
+        if (!cpus.empty() && !has_cpu(cpus, static_cast<unsigned int>(std::stoul(label.substr(3))))) continue;
+
+        times.idle += idle;
+        times.iowait += iowait;
+        times.total += user + nice + system + idle + iowait + irq + softirq + steal;
+        found = true;
+    }
+    return found;
+#else
+    (void)times;
+    (void)cpus;
+    return false;
+#endif
+}
+
+// Function to read memory pressure in %, as stall time over the time since the previous sample
+double read_memory_pressure(MemoryStall& previous) {
+#if defined(_WIN32)
+    // No PSI on Windows: scale memory load above 90% to 0-100
+    (void)previous;
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    if (!GlobalMemoryStatusEx(&status)) return 0.0;
+    return std::max(0.0, (static_cast<double>(status.dwMemoryLoad) - 90.0) * 10.0);
+#elif defined(__linux__)
+    // PSI "some total=" is the cumulative time (us) in which at least one task stalled on memory
+    std::ifstream psi_file("/proc/pressure/memory");
+    std::string line;
+    auto now = std::chrono::steady_clock::now();
+    while (std::getline(psi_file, line)) {
+        size_t pos = line.find("total=");
+        if (line.rfind("some", 0) == 0 && pos != std::string::npos) {
+            unsigned long long stall_us = 0;
+            try { stall_us = std::stoull(line.substr(pos + 6)); }
+            catch (...) { return 0.0; }
+
+            double pressure = 0.0;
+            double elapsed_us = std::chrono::duration<double, std::micro>(now - previous.time).count();
+            if (previous.valid && elapsed_us > 0.0) {
+                pressure = 100.0 * static_cast<double>(stall_us - previous.stall_us) / elapsed_us;
+            }
+            previous.stall_us = stall_us;
+            previous.time = now;
+            previous.valid = true;
+            return pressure;
+        }
+    }
+    return 0.0; // Kernel without PSI support
+#else
+    (void)previous;
+    return 0.0;
+#endif
+}
+
+// Function to parse a CPU list like "0-3,6" (returns an empty list on invalid input)
+std::vector<unsigned int> parse_cpu_list(const std::string& list) {
+    std::vector<unsigned int> cpus;
+    std::stringstream stream(list);
+    std::string token;
+    try {
+        while (std::getline(stream, token, ',')) {
+            size_t dash = token.find('-');
+            unsigned long first = std::stoul(token.substr(0, dash));
+            unsigned long last = (dash == std::string::npos) ? first : std::stoul(token.substr(dash + 1));
+            if (first > last || last >= 1024) return {};
+            for (unsigned long cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(static_cast<unsigned int>(cpu));
+            }
+        }
+    } catch (...) {
+        return {};
+    }
+    return cpus;
+}
+
+// Function to check that every requested core is available to this process (returns an error message, empty if fine)
+std::string check_cpu_affinity(const std::vector<unsigned int>& cpus) {
+#if defined(_WIN32)
+    DWORD_PTR process_mask = 0, system_mask = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+        return "Unable to read CPU affinity (error " + std::to_string(GetLastError()) + ")";
+    }
+    for (unsigned int cpu : cpus) {
+        if (cpu >= sizeof(DWORD_PTR) * 8 || !(process_mask & (static_cast<DWORD_PTR>(1) << cpu))) {
+            return "CPU " + std::to_string(cpu) + " is not available";
+        }
+    }
+    return "";
+#elif defined(__linux__)
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+        return "Unable to read CPU affinity: " + std::string(std::strerror(errno));
+    }
+    for (unsigned int cpu : cpus) {
+        if (cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &cpu_set)) {
+            return "CPU " + std::to_string(cpu) + " is not available";
+        }
+    }
+    return "";
+#else
+    return cpus.empty() ? "" : "CPU affinity is not supported on this platform";
+#endif
+}
+
+// Function to apply CPU affinity and nice/ionice classes to the calling thread and the ffmpeg processes it starts
+// On Windows priority class and affinity are process-wide: the caller must restore them if needed
+// Runs in every worker, so it stays silent: the affinity is validated up front by check_cpu_affinity
+void apply_process_limits(const GovernorSettings& governor) {
+#if defined(_WIN32)
+    if (governor.priority > 0) {
+        // Windows has no inheritable I/O class: the priority class is the closest equivalent
+        SetPriorityClass(GetCurrentProcess(), (governor.priority == 1) ? BELOW_NORMAL_PRIORITY_CLASS : IDLE_PRIORITY_CLASS);
+    }
+    if (!governor.cpu_affinity.empty()) {
+        DWORD_PTR mask = 0;
+        for (unsigned int cpu : governor.cpu_affinity) {
+            if (cpu < sizeof(DWORD_PTR) * 8) mask |= static_cast<DWORD_PTR>(1) << cpu;
+        }
+        SetProcessAffinityMask(GetCurrentProcess(), mask);
+    }
+#elif defined(__linux__)
+    if (governor.priority > 0) {
+        setpriority(PRIO_PROCESS, 0, (governor.priority == 1) ? 10 : 19);
+        // ioprio_set has no glibc wrapper: class 2 is best-effort (level 7 = lowest), class 3 is idle
+        const int ioprio_who_process = 1;
+        const int ioprio_class_shift = 13;
+        int ioprio = (governor.priority == 1) ? ((2 << ioprio_class_shift) | 7) : (3 << ioprio_class_shift);
+        syscall(SYS_ioprio_set, ioprio_who_process, 0, ioprio);
+    }
+    if (!governor.cpu_affinity.empty()) {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        for (unsigned int cpu : governor.cpu_affinity) {
+            if (cpu < CPU_SETSIZE) CPU_SET(cpu, &cpu_set);
+        }
+        sched_setaffinity(0, sizeof(cpu_set), &cpu_set);
+    }
+#else
+    (void)governor;
+#endif
+}
+
+// Governor thread function: resizes the active worker pool from measured system load
+void run_governor(GovernorSettings& governor, ConversionState& state) {
+    // CPU load is measured on the pinned cores only, when an affinity is set
+    CpuTimes previous;
+    bool cpu_available = read_cpu_times(previous, governor.cpu_affinity);
+    MemoryStall memory_previous;
+    read_memory_pressure(memory_previous);
+
+    while (!state.stop_requested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(governor_interval_ms));
+
+        double cpu_load = 0.0;
+        double iowait = 0.0;
+        CpuTimes current;
+        if (cpu_available && read_cpu_times(current, governor.cpu_affinity) && current.total > previous.total) {
+            double delta_total = static_cast<double>(current.total - previous.total);
+            double delta_idle = static_cast<double>(current.idle - previous.idle);
+            double delta_iowait = static_cast<double>(current.iowait - previous.iowait);
+            cpu_load = 100.0 * (delta_total - delta_idle - delta_iowait) / delta_total;
+            iowait = 100.0 * delta_iowait / delta_total;
+            previous = current;
+        }
+        double memory_pressure = read_memory_pressure(memory_previous);
+
+        unsigned int workers = governor.active_workers.load(std::memory_order_relaxed);
+        if (memory_pressure > governor.max_memory_pressure) {
+            workers = std::max(workers / 2, 1u); // Memory stalls hurt every process: back off hard
+        } else if (cpu_load > governor.max_cpu_load || iowait > governor.max_iowait) {
+            workers = std::max(workers - 1, 1u);
+        } else if (cpu_load < governor.max_cpu_load - governor_headroom && workers < governor.max_workers) {
+            workers++;
+        }
+        governor.active_workers.store(workers, std::memory_order_relaxed);
+    }
+}
+
+// Updated worker thread function: pulls files from the shared queue while the governor allows its slot
+void process_batch(const std::vector<fs::path>& files,
+                  unsigned int worker_index,
+                  const GovernorSettings& governor,
+                  ConversionState& state,
                   bool delete_original, 
                   const fs::path& base_path,
                   const fs::path& old_wav_folder, 
@@ -336,95 +644,123 @@ void process_batch(const std::vector<fs::path>& batch,
                   const fs::path& unrecognized_folder,
                   const fs::path& documentation_folder,
                   const fs::path& archive_folder) {
-    for (const auto& file : batch) {
-        if (state.stop_requested) return;
-
-        std::string extension = file.extension().string();
-        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    // Priority and affinity are per thread on Linux: ffmpeg children started from here inherit them
+    if (governor.enabled) {
+        apply_process_limits(governor);
+    }
 
-        if (file.filename().string().rfind("._", 0) == 0 || file.filename() == ".DS_Store") {
-            try { fs::remove(file); }
-            catch (...) {
-                std::lock_guard<std::mutex> lock(state.log_mutex);
-                state.error_messages.push_back("Failed to delete hidden file: " + file.string());
-            }
+    while (!state.stop_requested) {
+        // Park while the governor keeps this worker slot disabled (nothing to wait for once the queue is empty)
+        if (worker_index >= governor.active_workers.load(std::memory_order_relaxed)) {
+            if (state.next_file.load(std::memory_order_relaxed) >= files.size()) return;
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
             continue;
         }
 
-        if (has_extension(extension, analysis_extensions)) {
-            try { fs::remove(file); }
-            catch (...) {
-                std::lock_guard<std::mutex> lock(state.log_mutex);
-                state.error_messages.push_back("Failed to delete analysis file: " + file.string());
+        size_t index = state.next_file.fetch_add(1, std::memory_order_relaxed);
+        if (index >= files.size()) return;
+        const fs::path& file = files[index];
+
+        // Count the file as handled on every exit path of this iteration
+        struct HandledGuard {
+            std::atomic<int>& handled;
+            ~HandledGuard() { handled.fetch_add(1, std::memory_order_relaxed); }
+        } handled_guard{state.handled};
+
+        FileCategory category = classify_file(file);
+
+        // Moves throw on failure: log them instead of terminating the worker
+        try {
+            if (category == FileCategory::hidden) {
+                try { fs::remove(file); }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(state.log_mutex);
+                    state.error_messages.push_back("Failed to delete hidden file: " + file.string());
+                }
+                continue;
             }
-            continue;
-        }
 
-        if (has_extension(extension, unrecognized_extensions)) {
-            move_file_with_relative_structure(file, base_path, unrecognized_folder);
-            state.processed.fetch_add(1, std::memory_order_relaxed);
-            continue;
-        }
+            if (category == FileCategory::analysis) {
+                try { fs::remove(file); }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(state.log_mutex);
+                    state.error_messages.push_back("Failed to delete analysis file: " + file.string());
+                }
+                continue;
+            }
 
-        if (has_extension(extension, documentation_extensions)) {
-            move_file_with_relative_structure(file, base_path, documentation_folder);
-            state.processed.fetch_add(1, std::memory_order_relaxed);
-            continue;
-        }
+            if (category == FileCategory::unrecognized) {
+                move_file_with_relative_structure(file, base_path, unrecognized_folder);
+                state.processed.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
 
-        if (has_extension(extension, archive_extensions)) {
-            move_file_with_relative_structure(file, base_path, archive_folder);
-            state.processed.fetch_add(1, std::memory_order_relaxed);
-            continue;
-        }
+            if (category == FileCategory::documentation) {
+                move_file_with_relative_structure(file, base_path, documentation_folder);
+                state.processed.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            if (category == FileCategory::archive) {
+                move_file_with_relative_structure(file, base_path, archive_folder);
+                state.processed.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
 
-        if (has_extension(extension, lossless_extensions)) {
-            fs::path output_path = file;
-            output_path.replace_extension(".flac");
+            if (category == FileCategory::lossless) {
+                fs::path output_path = file;
+                output_path.replace_extension(".flac");
 
-            if (convert_file(file, output_path, state)) {
-                if (delete_original) {
-                    try { fs::remove(file); }
-                    catch (...) {
-                        std::lock_guard<std::mutex> lock(state.log_mutex);
-                        state.error_messages.push_back("Delete failed: " + file.string());
+                if (convert_file(file, output_path, state)) {
+                    if (delete_original) {
+                        try { fs::remove(file); }
+                        catch (...) {
+                            std::lock_guard<std::mutex> lock(state.log_mutex);
+                            state.error_messages.push_back("Delete failed: " + file.string());
+                        }
+                    } else {
+                        move_file_with_relative_structure(file, base_path, old_wav_folder);
                     }
+                    state.processed.fetch_add(1, std::memory_order_relaxed);
                 } else {
-                    move_file_with_relative_structure(file, base_path, old_wav_folder);
+                    state.errors.fetch_add(1, std::memory_order_relaxed);
                 }
+            } else if (category == FileCategory::midi) {
+                move_file_with_relative_structure(file, base_path, midi_folder);
+                state.processed.fetch_add(1, std::memory_order_relaxed);
+            } else if (category == FileCategory::arturia) {
+                move_file_with_relative_structure(file, base_path, arturia_folder);
+                state.processed.fetch_add(1, std::memory_order_relaxed);
+            } else if (category == FileCategory::serum) {
+                move_file_with_relative_structure(file, base_path, serum_folder);
+                state.processed.fetch_add(1, std::memory_order_relaxed);
+            } else if (category == FileCategory::vital) {
+                move_file_with_relative_structure(file, base_path, vital_folder);
+                state.processed.fetch_add(1, std::memory_order_relaxed);
+            } else if (category == FileCategory::ableton) {
+                move_file_with_relative_structure(file, base_path, ableton_folder);
+                state.processed.fetch_add(1, std::memory_order_relaxed);
+            } else if (category == FileCategory::natinst) {
+                move_file_with_relative_structure(file, base_path, natinst_folder);
                 state.processed.fetch_add(1, std::memory_order_relaxed);
-            } else {
-                state.errors.fetch_add(1, std::memory_order_relaxed);
             }
-        } else if (has_extension(extension, midi_extensions)) {
-            move_file_with_relative_structure(file, base_path, midi_folder);
-            state.processed.fetch_add(1, std::memory_order_relaxed);
-        } else if (has_extension(extension, arturia_extensions)) {
-            move_file_with_relative_structure(file, base_path, arturia_folder);
-            state.processed.fetch_add(1, std::memory_order_relaxed);
-        } else if (has_extension(extension, serum_extensions)) {
-            move_file_with_relative_structure(file, base_path, serum_folder);
-            state.processed.fetch_add(1, std::memory_order_relaxed);
-        } else if (has_extension(extension, vital_extensions)) {
-            move_file_with_relative_structure(file, base_path, vital_folder);
-            state.processed.fetch_add(1, std::memory_order_relaxed);
-        } else if (has_extension(extension, ableton_extensions)) {
-            move_file_with_relative_structure(file, base_path, ableton_folder);
-            state.processed.fetch_add(1, std::memory_order_relaxed);
-        } else if (has_extension(extension, natinst_extensions)) {
-            move_file_with_relative_structure(file, base_path, natinst_folder);
-            state.processed.fetch_add(1, std::memory_order_relaxed);
+        } catch (const std::exception& e) {
+            std::lock_guard<std::mutex> lock(state.log_mutex);
+            state.error_messages.push_back("Failed to process [" + file.string() + "]: " + e.what());
+            state.errors.fetch_add(1, std::memory_order_relaxed);
         }
     }
 }
 
 // Progress bar function
-void display_progress(ConversionState& state) {
+void display_progress(ConversionState& state, const GovernorSettings& governor) {
     const int bar_width = 50;
-    while (state.processed < state.total_files && !state.stop_requested) {
-        float progress = static_cast<float>(state.processed.load(std::memory_order_relaxed)) / state.total_files;
+    while (true) {
+        int handled = state.handled.load(std::memory_order_relaxed);
+        float progress = static_cast<float>(handled) / state.total_files;
         int pos = bar_width * progress;
-        
+
+
         std::cout << "[";
         for (int i = 0; i < bar_width; ++i) {
             if (i < pos) std::cout << "=";
@@ -432,9 +768,15 @@ void display_progress(ConversionState& state) {
             else std::cout << " ";
         }
         std::cout << "] " << int(progress * 100.0) << "% "
-                << state.processed.load(std::memory_order_relaxed) << "/" << state.total_files << "\r";
+                << handled << "/" << state.total_files;
+        if (governor.enabled) {
+            std::cout << " [workers: " << governor.active_workers.load(std::memory_order_relaxed) << "] ";
+        }
+        std::cout << "\r";
         std::cout.flush();
-        
+
+        // Last frame drawn at 100% (or where a stop left it)
+        if (handled >= state.total_files || state.stop_requested) break;
         std::this_thread::sleep_for(std::chrono::milliseconds(200));
     }
     std::cout << std::endl; // Ensure the progress bar ends cleanly
@@ -457,6 +799,61 @@ void delete_empty_folders(const fs::path& root_path, std::vector<fs::path>& dele
     }
 }
 
+// Function to collect the files to process, grouped by extension
+std::vector<fs::path> collect_files(const fs::path& root_path, bool move_midi, bool move_banks) {
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::recursive_directory_iterator(root_path)) {
+        if (entry.is_regular_file()) {
+            FileCategory category = classify_file(entry.path());
+            bool is_bank = category == FileCategory::arturia || category == FileCategory::serum ||
+                           category == FileCategory::vital || category == FileCategory::ableton ||
+                           category == FileCategory::natinst;
+            if (category == FileCategory::other ||
+                (category == FileCategory::midi && !move_midi) ||
+                (is_bank && !move_banks)) {
+                continue;
+            }
+            files.push_back(entry.path());
+        }
+    }
+    return files;
+}
+
+// Function to start one worker thread per governor slot over the shared file queue
+void start_workers(std::vector<std::thread>& workers,
+                   const std::vector<fs::path>& files,
+                   ConversionState& state,
+                   const GovernorSettings& governor,
+                   bool delete_original,
+                   const fs::path& root_path) {
+    unsigned int worker_count = static_cast<unsigned int>(std::min<size_t>(governor.max_workers, files.size()));
+    for (unsigned int i = 0; i < worker_count; ++i) {
+        workers.emplace_back(process_batch, std::cref(files), i, std::cref(governor), std::ref(state), delete_original,
+                             root_path, root_path / old_wav_folder_name, root_path / midi_folder_name,
+                             root_path / arturia_folder_name, root_path / serum_folder_name,
+                             root_path / vital_folder_name, root_path / ableton_folder_name,
+                             root_path / natinst_folder_name, root_path / unrecognized_folder_name,
+                             root_path / documentation_folder_name, root_path / archive_folder_name);
+    }
+}
+
+// Function to prompt for a numeric setting in [min_value, max_value], keeping the default on empty or invalid input
+double prompt_number(const std::string& question, double default_value, double min_value, double max_value) {
+    std::cout << question << " (default is [" << default_value << "]): ";
+    std::string input;
+    std::getline(std::cin, input);
+    if (input.empty()) return default_value;
+    try {
+        double value = std::stod(input);
+        if (!std::isfinite(value)) throw std::invalid_argument("not finite");
+        return std::min(std::max(value, min_value), max_value);
+    } catch (...) {
+        std::cerr << "Invalid number! Using default [" << default_value << "]\n";
+        return default_value;
+    }
+}
+
+#ifndef WAV2FLAC_NO_MAIN // Defined when the engine is built as the Python extension module
 int main() {
     // Verify ffmpeg installation
     if (system("ffmpeg -version > NUL 2>&1") != 0) { // Suppress output
@@ -540,42 +937,52 @@ int main() {
         std::cout << "Note: all bank files will be moved to separate folders, like for instance: [" << (root_path / arturia_folder_name) << "]\n";
     }
 
-    // Prepare folders for old WAV files, MIDI files, and other categories
-    fs::path old_wav_folder = root_path / old_wav_folder_name;
-    fs::path midi_folder = root_path / midi_folder_name;
-    fs::path arturia_folder = root_path / arturia_folder_name;
-    fs::path serum_folder = root_path / serum_folder_name;
-    fs::path vital_folder = root_path / vital_folder_name;
-    fs::path ableton_folder = root_path / ableton_folder_name;
-    fs::path natinst_folder = root_path / natinst_folder_name;
-    fs::path unrecognized_folder = root_path / unrecognized_folder_name;
-    fs::path documentation_folder = root_path / documentation_folder_name;
-    fs::path archive_folder = root_path / archive_folder_name;
+    // Default: fixed worker count at normal priority
+    GovernorSettings governor;
+    governor.max_workers = thread_count;
+    std::cout << "Run as a background job with a load-aware worker count? (y/[n]): ";
+    char governor_response;
+    std::cin.get(governor_response);
+    governor.enabled = (tolower(governor_response) == 'y');
+    if (governor_response != '\n') std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear input buffer
 
-    // Grouping files by extension
-    std::vector<fs::path> audio_files;
-    for (const auto& entry : fs::recursive_directory_iterator(root_path)) {
-        if (entry.is_regular_file()) {
-            std::string extension = entry.path().extension().string();
-            std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
-            if (has_extension(extension, lossless_extensions) || 
-                (move_midi && has_extension(extension, midi_extensions)) ||
-                (move_banks && (has_extension(extension, arturia_extensions) ||
-                                has_extension(extension, serum_extensions) ||
-                                has_extension(extension, vital_extensions) ||
-                                has_extension(extension, ableton_extensions) ||
-                                has_extension(extension, natinst_extensions))) ||
-                has_extension(extension, analysis_extensions) ||
-                has_extension(extension, unrecognized_extensions) ||
-                has_extension(extension, documentation_extensions) ||
-                has_extension(extension, archive_extensions) ||
-                entry.path().filename().string().rfind("._", 0) == 0 ||
-                entry.path().filename() == ".DS_Store") {
-                audio_files.push_back(entry.path());
+    if (governor.enabled) {
+        std::cout << "CPU cores to run on, e.g. 0-3,6 (default is all): ";
+        std::string cpu_input;
+        std::getline(std::cin, cpu_input);
+        if (!cpu_input.empty()) {
+            governor.cpu_affinity = parse_cpu_list(cpu_input);
+            std::string affinity_error = governor.cpu_affinity.empty() ? "Invalid CPU list" : check_cpu_affinity(governor.cpu_affinity);
+            if (!affinity_error.empty()) {
+                std::cerr << affinity_error << "! Using all cores.\n";
+                governor.cpu_affinity.clear();
+            } else {
+                governor.max_workers = std::min(governor.max_workers, static_cast<unsigned int>(governor.cpu_affinity.size()));
             }
         }
+
+        governor.max_workers = static_cast<unsigned int>(prompt_number("Maximum worker threads", governor.max_workers, 1.0, max_worker_threads));
+        governor.max_cpu_load = prompt_number("Maximum CPU load in %", governor.max_cpu_load, 0.0, 100.0);
+        governor.max_iowait = prompt_number("Maximum CPU iowait in %", governor.max_iowait, 0.0, 100.0);
+        governor.max_memory_pressure = prompt_number("Maximum memory pressure in %", governor.max_memory_pressure, 0.0, 100.0);
+
+        std::cout << "Process priority: (n)ormal, [l]ow, (i)dle: ";
+        char priority_response;
+        std::cin.get(priority_response);
+        switch (tolower(priority_response)) {
+            case 'n': governor.priority = 0; break;
+            case 'i': governor.priority = 2; break;
+            default:  governor.priority = 1; break;
+        }
+        if (priority_response != '\n') std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // Clear input buffer
+
+        std::cout << "Note: up to " << governor.max_workers << " workers, fewer while CPU load > " << governor.max_cpu_load
+                  << "%, iowait > " << governor.max_iowait << "% or memory pressure > " << governor.max_memory_pressure << "%\n";
     }
-    
+
+    // Grouping files by extension
+    std::vector<fs::path> audio_files = collect_files(root_path, move_midi, move_banks);
+
     if (audio_files.empty()) {
         std::cout << "No audio files found!\n";
         std::cout << "Press Enter to exit...";
@@ -585,33 +992,28 @@ int main() {
 
     state.total_files = audio_files.size();
     
-    // Partitioning files into batches for threads
-    std::vector<std::vector<fs::path>> batches(thread_count);
-    for (size_t i = 0; i < audio_files.size(); ++i) {
-        batches[i % thread_count].push_back(audio_files[i]);
-    }
-
-    // Start threads for processing
+    // Start threads for processing (the governor decides how many of them are active)
+    governor.active_workers = governor.enabled ? std::max(governor.max_workers / 2, 1u) : governor.max_workers;
     std::vector<std::thread> workers;
-    for (auto& batch : batches) {
-        if (!batch.empty()) {
-            workers.emplace_back(process_batch, std::ref(batch), std::ref(state), delete_original, 
-                                 root_path, old_wav_folder, midi_folder, arturia_folder, serum_folder, 
-                                 vital_folder, ableton_folder, natinst_folder, unrecognized_folder, 
-                                 documentation_folder, archive_folder);
-        }
+    start_workers(workers, audio_files, state, governor, delete_original, root_path);
+
+    // Start load monitoring and progress display
+    std::thread governor_thread;
+    if (governor.enabled) {
+        governor_thread = std::thread(run_governor, std::ref(governor), std::ref(state));
     }
+    std::thread progress_thread(display_progress, std::ref(state), std::cref(governor));
 
-    // Start progress display
-    std::thread progress_thread(display_progress, std::ref(state));
-    
     // Waiting for threads to finish
     for (auto& worker : workers) {
         worker.join();
     }
-    
+
     state.stop_requested = true;
     progress_thread.join();
+    if (governor_thread.joinable()) {
+        governor_thread.join();
+    }
 
     // Analyze and delete empty folders
     std::vector<fs::path> deleted_folders;
@@ -685,4 +1087,5 @@ int main() {
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 
     return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -8,13 +8,17 @@ Created on Tue Jul 23 14:39:54 2024
 ####~ Modules recall    ~####
 import os
 from os.path import isdir, isfile, join, basename, splitext, dirname, exists
-from pydub import AudioSegment
 from tqdm import tqdm
 import shutil
 from unidecode import unidecode
 import unicodedata
 import threading
 from concurrent.futures import ThreadPoolExecutor, as_completed
+try:
+    import wav2flac_native # Compiled C++ engine (see examples/commands-example.txt), same behaviour as the exe
+except ImportError:
+    wav2flac_native = None
+    from pydub import AudioSegment # Pure Python fallback
 
 ####~ Requirements      ~####
 if shutil.which('ffmpeg') == None:
@@ -342,7 +346,13 @@ if convert_ascii:
     print("Converting names to ASCII...")
     
     rename_tracker = RenameTracker()
-    convert_names_to_ascii(origin_scan_path[0], rename_tracker)
+    if wav2flac_native is not None:
+        native_renames = wav2flac_native.rename_to_ascii(origin_scan_path[0])
+        rename_tracker.renamed_files = native_renames['renamed_files']
+        rename_tracker.renamed_folders = native_renames['renamed_folders']
+        rename_tracker.rename_errors = native_renames['errors']
+    else:
+        convert_names_to_ascii(origin_scan_path[0], rename_tracker)
     
     print("ASCII conversion completed.")
 
@@ -395,15 +405,25 @@ while len(scan_path) >= 1:
     
 files_succ_conv = 0
 files_err = list()
-for idx in tqdm(range(len(files_conv))):
-    curr_fl_pth = files_conv[idx]
-    try:
-        succ = fileconv(curr_fl_pth, remExsWav=rem_wav, moveMIDI=move_mid, moveBanks=move_bnk, orig_path=origin_scan_path[0])
-        if succ:
-            files_succ_conv += 1
-    except Exception as e:
-        print(f"Error with sample {curr_fl_pth}: {e}")
-        files_err.append(curr_fl_pth)
+native_err_msgs = list() # Native engine messages (failed conversions, deletes and moves), only for the log
+if wav2flac_native is not None: # Native threads, without the GIL
+    files_native = wav2flac_native.scan(origin_scan_path[0], move_midi=move_mid, move_banks=move_bnk)
+    with tqdm(total=len(files_native)) as pbar:
+        def native_progress(handled, total): # Converted, moved, deleted or failed
+            pbar.update(handled - pbar.n)
+        native_result = wav2flac_native.convert(files_native, origin_scan_path[0], delete_original=rem_wav, progress=native_progress)
+    files_succ_conv = native_result['processed']
+    native_err_msgs = native_result['error_messages']
+else:
+    for idx in tqdm(range(len(files_conv))):
+        curr_fl_pth = files_conv[idx]
+        try:
+            succ = fileconv(curr_fl_pth, remExsWav=rem_wav, moveMIDI=move_mid, moveBanks=move_bnk, orig_path=origin_scan_path[0])
+            if succ:
+                files_succ_conv += 1
+        except Exception as e:
+            print(f"Error with sample {curr_fl_pth}: {e}")
+            files_err.append(curr_fl_pth)
 
 some_fld_empty = True
 remvd_flds = list()
@@ -458,13 +478,18 @@ if exists(err_report_filename):
     os.remove(err_report_filename)
 
 # Write comprehensive error log
-if len(files_err) > 0 or len(fold_hidd_nr) > 0 or (convert_ascii and rename_tracker.rename_errors):
+if len(files_err) > 0 or len(native_err_msgs) > 0 or len(fold_hidd_nr) > 0 or (convert_ascii and rename_tracker.rename_errors):
     with open(err_report_filename, 'w', encoding='utf-8') as f:
         if len(files_err) > 0:
             f.write('=== CONVERSION ERRORS (consider ASCII renaming) ===\n')
             for line in files_err:
                 f.write(f"{unidecode(line)}\n")
             f.write('\n')
+        if len(native_err_msgs) > 0:
+            f.write('=== CONVERSION ERRORS ===\n')
+            for line in native_err_msgs:
+                f.write(f"{unidecode(line)}\n")
+            f.write('\n')
         if len(fold_hidd_nr) > 0:
             f.write('=== FOLDER DELETION ERRORS (check permissions) ===\n')
             for line in fold_hidd_nr:
@@ -476,7 +501,11 @@ if len(files_err) > 0 or len(fold_hidd_nr) > 0 or (convert_ascii and rename_trac
             for error in rename_tracker.rename_errors:
                 f.write(f"{error}\n")
 
-print(f"Successfully converted {files_succ_conv} (of {files_succ_conv+len(files_err)}) audio files into flac")
+if wav2flac_native is not None: # Same counters of the exe: processed includes moved files
+    print(f"Files processed (converted into flac or moved): {files_succ_conv} (of {native_result['total']})")
+    print(f"Errors: {native_result['errors']}")
+else:
+    print(f"Successfully converted {files_succ_conv} (of {files_succ_conv+len(files_err)}) audio files into flac")
 
 if convert_ascii:
     print(f"Files renamed to ASCII: {len(rename_tracker.renamed_files)}")
@@ -484,7 +513,7 @@ if convert_ascii:
     if rename_tracker.rename_errors:
         print(f"ASCII conversion errors: {len(rename_tracker.rename_errors)}")
 
-if len(files_err) > 0 or len(fold_hidd_nr) > 0 or (convert_ascii and rename_tracker.rename_errors):
+if len(files_err) > 0 or len(native_err_msgs) > 0 or len(fold_hidd_nr) > 0 or (convert_ascii and rename_tracker.rename_errors):
     print("Error details saved in conversion_errors.txt")
 
 input('Press Enter to exit...')
\ No newline at end of file
@@ -0,0 +1,372 @@
+// Python extension module exposing the wav2flac engine (see examples/commands-example.txt to build it)
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#define WAV2FLAC_NO_MAIN
+#include "wav2flac.cpp"
+
+// Function to convert a str/bytes/os.PathLike object to a path (sets a Python error on failure)
+bool path_from_object(PyObject* object, fs::path& path) {
+    PyObject* encoded = nullptr;
+    if (!PyUnicode_FSConverter(object, &encoded)) return false;
+    path = fs::u8path(PyBytes_AS_STRING(encoded));
+    Py_DECREF(encoded);
+    return true;
+}
+
+// Function to convert a path to a str, using the same encoding as os.fsdecode
+PyObject* object_from_path(const fs::path& path) {
+    std::string utf8 = path.u8string();
+    return PyUnicode_DecodeFSDefaultAndSize(utf8.c_str(), static_cast<Py_ssize_t>(utf8.size()));
+}
+
+// Function to build a list of str from a list of messages (undecodable bytes are replaced)
+PyObject* list_from_strings(const std::vector<std::string>& strings) {
+    PyObject* list = PyList_New(static_cast<Py_ssize_t>(strings.size()));
+    if (!list) return nullptr;
+    for (size_t i = 0; i < strings.size(); ++i) {
+        PyObject* item = PyUnicode_DecodeUTF8(strings[i].c_str(), static_cast<Py_ssize_t>(strings[i].size()), "replace");
+        if (!item) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, static_cast<Py_ssize_t>(i), item);
+    }
+    return list;
+}
+
+// Function to build a list of (old, new) tuples from the rename tracker
+PyObject* list_from_renames(const std::vector<std::pair<std::string, std::string>>& renames) {
+    PyObject* list = PyList_New(static_cast<Py_ssize_t>(renames.size()));
+    if (!list) return nullptr;
+    for (size_t i = 0; i < renames.size(); ++i) {
+        PyObject* item = Py_BuildValue("(NN)",
+                                       object_from_path(fs::path(renames[i].first)),
+                                       object_from_path(fs::path(renames[i].second)));
+        if (!item) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, static_cast<Py_ssize_t>(i), item);
+    }
+    return list;
+}
+
+// Structure restoring the caller's process-wide priority class and affinity on scope exit
+// Only Windows needs it: on Linux the limits live and die with the worker threads
+struct ProcessLimitsGuard {
+#if defined(_WIN32)
+    DWORD priority_class{0};
+    DWORD_PTR affinity{0};
+    bool affinity_saved{false};
+
+    ProcessLimitsGuard() {
+        DWORD_PTR system_affinity = 0;
+        priority_class = GetPriorityClass(GetCurrentProcess());
+        affinity_saved = GetProcessAffinityMask(GetCurrentProcess(), &affinity, &system_affinity) != 0;
+    }
+
+    ~ProcessLimitsGuard() {
+        if (priority_class != 0) SetPriorityClass(GetCurrentProcess(), priority_class);
+        if (affinity_saved) SetProcessAffinityMask(GetCurrentProcess(), affinity);
+    }
+#endif
+};
+
+// Function to read an optional percentage argument in [0, 100], keeping the default if not given (sets a Python error on failure)
+bool percent_from_object(PyObject* object, const char* name, double& value) {
+    if (object == nullptr) return true;
+    double number = PyFloat_AsDouble(object);
+    if (number == -1.0 && PyErr_Occurred()) return false;
+    if (!(number >= 0.0 && number <= 100.0)) { // Also rejects NaN
+        PyErr_Format(PyExc_ValueError, "%s must be between 0 and 100", name);
+        return false;
+    }
+    value = number;
+    return true;
+}
+
+PyDoc_STRVAR(py_convert_to_ascii_doc,
+"convert_to_ascii(name)\n--\n\n"
+"Return name with non-ASCII characters replaced by their ASCII equivalents ('*' if unknown).");
+
+static PyObject* py_convert_to_ascii(PyObject*, PyObject* args) {
+    const char* name = nullptr;
+    if (!PyArg_ParseTuple(args, "s:convert_to_ascii", &name)) return nullptr;
+    std::string ascii_name = convert_to_ascii(std::string(name));
+    return PyUnicode_FromStringAndSize(ascii_name.c_str(), static_cast<Py_ssize_t>(ascii_name.size()));
+}
+
+PyDoc_STRVAR(py_classify_doc,
+"classify(path)\n--\n\n"
+"Return the category of a file: 'hidden', 'analysis', 'unrecognized', 'documentation', 'archive',\n"
+"'lossless', 'midi', 'arturia', 'serum', 'vital', 'ableton', 'natinst' or 'other'.");
+
+static PyObject* py_classify(PyObject*, PyObject* args) {
+    PyObject* path_object = nullptr;
+    if (!PyArg_ParseTuple(args, "O:classify", &path_object)) return nullptr;
+    fs::path path;
+    if (!path_from_object(path_object, path)) return nullptr;
+    return PyUnicode_FromString(category_name(classify_file(path)).c_str());
+}
+
+PyDoc_STRVAR(py_scan_doc,
+"scan(root, move_midi=True, move_banks=True)\n--\n\n"
+"Return the files under root that the conversion will process, like the executable does.");
+
+static PyObject* py_scan(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"root", "move_midi", "move_banks", nullptr};
+    PyObject* root_object = nullptr;
+    int move_midi = 1;
+    int move_banks = 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|pp:scan", const_cast<char**>(keywords),
+                                     &root_object, &move_midi, &move_banks)) {
+        return nullptr;
+    }
+    fs::path root_path;
+    if (!path_from_object(root_object, root_path)) return nullptr;
+
+    std::vector<fs::path> files;
+    std::string error;
+    Py_BEGIN_ALLOW_THREADS
+    try {
+        files = collect_files(root_path, move_midi != 0, move_banks != 0);
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+    Py_END_ALLOW_THREADS
+
+    if (!error.empty()) {
+        PyErr_SetString(PyExc_OSError, error.c_str());
+        return nullptr;
+    }
+
+    PyObject* list = PyList_New(static_cast<Py_ssize_t>(files.size()));
+    if (!list) return nullptr;
+    for (size_t i = 0; i < files.size(); ++i) {
+        PyObject* item = object_from_path(files[i]);
+        if (!item) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, static_cast<Py_ssize_t>(i), item);
+    }
+    return list;
+}
+
+PyDoc_STRVAR(py_rename_to_ascii_doc,
+"rename_to_ascii(root)\n--\n\n"
+"Rename every file and folder under root to its ASCII equivalent.\n"
+"Return a dict with 'renamed_files' and 'renamed_folders' ((old, new) tuples) and 'errors'.");
+
+static PyObject* py_rename_to_ascii(PyObject*, PyObject* args) {
+    PyObject* root_object = nullptr;
+    if (!PyArg_ParseTuple(args, "O:rename_to_ascii", &root_object)) return nullptr;
+    fs::path root_path;
+    if (!path_from_object(root_object, root_path)) return nullptr;
+
+    RenameTracker tracker;
+    Py_BEGIN_ALLOW_THREADS
+    convert_names_to_ascii(root_path, tracker);
+    Py_END_ALLOW_THREADS
+
+    return Py_BuildValue("{s:N,s:N,s:N}",
+                         "renamed_files", list_from_renames(tracker.renamed_files),
+                         "renamed_folders", list_from_renames(tracker.renamed_folders),
+                         "errors", list_from_strings(tracker.rename_errors));
+}
+
+PyDoc_STRVAR(py_convert_doc,
+"convert(files, root, delete_original=False, workers=0, progress=None, governor=False,\n"
+"        max_cpu_load=85.0, max_iowait=20.0, max_memory_pressure=10.0, priority=0, cpus=None)\n--\n\n"
+"Convert and move files (as returned by scan) relative to root, on native threads without the GIL.\n"
+"workers caps the worker count (0 = all cores). progress(handled, total) is called from the\n"
+"calling thread a few times per second, handled counting converted, moved, deleted and failed files;\n"
+"an exception in it stops the conversion.\n"
+"governor=True makes the worker count follow the system load, within the max_* caps (0-100%).\n"
+"priority (0 = normal, 1 = low, 2 = idle) and cpus (e.g. '0-3,6') apply to the worker threads and\n"
+"their ffmpeg processes only (on Windows to the whole process, restored before returning).\n"
+"The caps, priority and cpus require governor=True.\n"
+"Return a dict with 'total', 'handled', 'processed', 'errors' and 'error_messages'.");
+
+static PyObject* py_convert(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"files", "root", "delete_original", "workers", "progress", "governor",
+                                     "max_cpu_load", "max_iowait", "max_memory_pressure", "priority", "cpus", nullptr};
+    PyObject* files_object = nullptr;
+    PyObject* root_object = nullptr;
+    int delete_original = 0;
+    int workers = 0;
+    PyObject* progress = Py_None;
+    int governor_enabled = 0;
+    PyObject* max_cpu_load_object = nullptr;
+    PyObject* max_iowait_object = nullptr;
+    PyObject* max_memory_pressure_object = nullptr;
+    int priority = 0;
+    const char* cpus = nullptr;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|piOpOOOiz:convert", const_cast<char**>(keywords),
+                                     &files_object, &root_object, &delete_original, &workers, &progress,
+                                     &governor_enabled, &max_cpu_load_object, &max_iowait_object,
+                                     &max_memory_pressure_object, &priority, &cpus)) {
+        return nullptr;
+    }
+    bool has_cpus = cpus != nullptr && cpus[0] != '\0';
+    if (!governor_enabled && (max_cpu_load_object || max_iowait_object || max_memory_pressure_object || priority != 0 || has_cpus)) {
+        PyErr_SetString(PyExc_ValueError, "max_cpu_load, max_iowait, max_memory_pressure, priority and cpus require governor=True");
+        return nullptr;
+    }
+    if (progress != Py_None && !PyCallable_Check(progress)) {
+        PyErr_SetString(PyExc_TypeError, "progress must be callable or None");
+        return nullptr;
+    }
+    if (workers < 0 || static_cast<unsigned int>(workers) > max_worker_threads) {
+        PyErr_Format(PyExc_ValueError, "workers must be between 0 and %u", max_worker_threads);
+        return nullptr;
+    }
+    if (priority < 0 || priority > 2) {
+        PyErr_SetString(PyExc_ValueError, "priority must be 0 (normal), 1 (low) or 2 (idle)");
+        return nullptr;
+    }
+
+    fs::path root_path;
+    if (!path_from_object(root_object, root_path)) return nullptr;
+
+    std::vector<fs::path> files;
+    PyObject* sequence = PySequence_Fast(files_object, "files must be a sequence of paths");
+    if (!sequence) return nullptr;
+    Py_ssize_t file_count = PySequence_Fast_GET_SIZE(sequence);
+    files.resize(static_cast<size_t>(file_count));
+    for (Py_ssize_t i = 0; i < file_count; ++i) {
+        if (!path_from_object(PySequence_Fast_GET_ITEM(sequence, i), files[static_cast<size_t>(i)])) {
+            Py_DECREF(sequence);
+            return nullptr;
+        }
+    }
+    Py_DECREF(sequence);
+
+    GovernorSettings governor;
+    governor.enabled = governor_enabled != 0;
+    governor.max_workers = workers > 0 ? static_cast<unsigned int>(workers) : std::max(std::thread::hardware_concurrency(), 1u);
+    if (!percent_from_object(max_cpu_load_object, "max_cpu_load", governor.max_cpu_load) ||
+        !percent_from_object(max_iowait_object, "max_iowait", governor.max_iowait) ||
+        !percent_from_object(max_memory_pressure_object, "max_memory_pressure", governor.max_memory_pressure)) {
+        return nullptr;
+    }
+    governor.priority = priority;
+    if (has_cpus) {
+        governor.cpu_affinity = parse_cpu_list(cpus);
+        if (governor.cpu_affinity.empty()) {
+            PyErr_Format(PyExc_ValueError, "invalid CPU list: '%s'", cpus);
+            return nullptr;
+        }
+        std::string affinity_error = check_cpu_affinity(governor.cpu_affinity);
+        if (!affinity_error.empty()) {
+            PyErr_SetString(PyExc_ValueError, affinity_error.c_str());
+            return nullptr;
+        }
+        if (workers == 0) {
+            governor.max_workers = std::min(governor.max_workers, static_cast<unsigned int>(governor.cpu_affinity.size()));
+        }
+    }
+    governor.active_workers = governor.enabled ? std::max(governor.max_workers / 2, 1u) : governor.max_workers;
+
+    ConversionState state;
+    state.total_files = static_cast<int>(files.size());
+
+    // Workers only touch C++ state: the GIL is needed just for the progress callback
+    [[maybe_unused]] ProcessLimitsGuard limits_guard;
+    std::vector<std::thread> worker_threads;
+    std::thread governor_thread;
+    std::thread joiner;
+    std::atomic<bool> finished{false};
+    bool start_failed = false;
+    std::string start_error;
+    Py_BEGIN_ALLOW_THREADS
+    try {
+        start_workers(worker_threads, files, state, governor, delete_original != 0, root_path);
+        if (governor.enabled) {
+            governor_thread = std::thread(run_governor, std::ref(governor), std::ref(state));
+        }
+        joiner = std::thread([&worker_threads, &finished]() {
+            for (auto& worker : worker_threads) {
+                worker.join();
+            }
+            finished = true;
+        });
+    } catch (const std::exception& e) {
+        // The joiner is started last, so here the threads already running are joined directly
+        start_failed = true;
+        start_error = e.what();
+        state.stop_requested = true;
+        for (auto& worker : worker_threads) {
+            if (worker.joinable()) worker.join();
+        }
+        if (governor_thread.joinable()) {
+            governor_thread.join();
+        }
+    }
+    Py_END_ALLOW_THREADS
+
+    if (start_failed) {
+        PyErr_Format(PyExc_RuntimeError, "unable to start worker threads: %s", start_error.c_str());
+        return nullptr;
+    }
+
+    bool failed = false;
+    while (!failed) {
+        bool done = finished.load();
+        if (progress != Py_None) {
+            PyObject* result = PyObject_CallFunction(progress, "ii", state.handled.load(), state.total_files.load());
+            if (result) Py_DECREF(result);
+            else failed = true;
+        }
+        if (done || failed) break;
+        if (PyErr_CheckSignals() != 0) {
+            failed = true;
+            break;
+        }
+        Py_BEGIN_ALLOW_THREADS
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        Py_END_ALLOW_THREADS
+    }
+
+    // On failure workers stop after their current file
+    Py_BEGIN_ALLOW_THREADS
+    if (failed) state.stop_requested = true;
+    joiner.join();
+    state.stop_requested = true;
+    if (governor_thread.joinable()) {
+        governor_thread.join();
+    }
+    Py_END_ALLOW_THREADS
+
+    if (failed) return nullptr;
+
+    return Py_BuildValue("{s:i,s:i,s:i,s:i,s:N}",
+                         "total", state.total_files.load(),
+                         "handled", state.handled.load(),
+                         "processed", state.processed.load(),
+                         "errors", state.errors.load(),
+                         "error_messages", list_from_strings(state.error_messages));
+}
+
+static PyMethodDef wav2flac_methods[] = {
+    {"convert_to_ascii", py_convert_to_ascii, METH_VARARGS, py_convert_to_ascii_doc},
+    {"classify", py_classify, METH_VARARGS, py_classify_doc},
+    {"scan", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(py_scan)), METH_VARARGS | METH_KEYWORDS, py_scan_doc},
+    {"rename_to_ascii", py_rename_to_ascii, METH_VARARGS, py_rename_to_ascii_doc},
+    {"convert", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(py_convert)), METH_VARARGS | METH_KEYWORDS, py_convert_doc},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static struct PyModuleDef wav2flac_module = {
+    PyModuleDef_HEAD_INIT,
+    "wav2flac_native",
+    "Native wav2flac engine: scan, classify, ASCII rename and ffmpeg conversion on native threads.",
+    -1,
+    wav2flac_methods,
+    nullptr, nullptr, nullptr, nullptr
+};
+
+PyMODINIT_FUNC PyInit_wav2flac_native(void) {
+    return PyModule_Create(&wav2flac_module);
+}